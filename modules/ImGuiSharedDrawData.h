@@ -4,7 +4,9 @@
 #include <imgui/imgui.h>
 
 #include <stdint.h>
+#include <string.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -133,19 +135,275 @@ namespace ImGui
         return sharedDrawData;
     }
 
-    ImDrawData *RenderSharedDrawData(const std::vector<uint8_t> &data)
-    {
-        size_t readIndex = 0;
+    // Shared data is sent as chunks of at most this size, a zero size chunk ends the packet
+    constexpr uint32_t SharedDataMaxChunkSize = 64 * 1024; // 64KB
 
+    template <typename Writer>
+    void WriteSharedDataChunks(const std::vector<uint8_t> &data, Writer &&writer)
+    {
         if (data.empty())
-            return ImGui::GetDrawData();
+            return;
 
-        // Read cmd lists count
-        int cmdListsCount = *reinterpret_cast<int *>(const_cast<uint8_t *>(data.data()));
-        readIndex += sizeof(cmdListsCount);
-        if (1 > cmdListsCount)
-            return ImGui::GetDrawData();
+        for (size_t writeIndex = 0; writeIndex < data.size();)
+        {
+            auto chunkSize = static_cast<uint32_t>((std::min)(data.size() - writeIndex, static_cast<size_t>(SharedDataMaxChunkSize)));
+            writer(&chunkSize, sizeof(chunkSize));
+            writer(data.data() + writeIndex, chunkSize);
+            writeIndex += chunkSize;
+        }
+
+        uint32_t endChunkSize = 0;
+        writer(&endChunkSize, sizeof(endChunkSize));
+    }
+
+    class SharedDrawDataDecoder
+    {
+    public:
+        struct CmdListData
+        {
+            // NOTE: ImVector leaves grown elements uninitialized, they are overwritten by the received bytes
+            ImVector<ImDrawVert> vtxBuffer;
+            ImVector<ImDrawIdx> idxBuffer;
+            ImVector<ImDrawCmd> cmdBuffer;
+
+            CmdListData() = default;
+            CmdListData(CmdListData &&other) noexcept
+            {
+                vtxBuffer.swap(other.vtxBuffer);
+                idxBuffer.swap(other.idxBuffer);
+                cmdBuffer.swap(other.cmdBuffer);
+            }
+        };
+
+    public:
+        SharedDrawDataDecoder(size_t maxFrameSize, int maxCmdListsCount)
+            : m_maxFrameSize(maxFrameSize), m_maxCmdListsCount(maxCmdListsCount)
+        {
+        }
+        SharedDrawDataDecoder(const SharedDrawDataDecoder &) = delete;
+        SharedDrawDataDecoder &operator=(const SharedDrawDataDecoder &) = delete;
+
+        // Get where the next bytes of the frame should be written, returns nullptr if the frame is over or exceeds the budget
+        uint8_t *BeginWrite(size_t maxSize, size_t &writeSize)
+        {
+            if (Stage::Completed == m_stage || 0 == maxSize)
+                return nullptr;
+
+            writeSize = (std::min)(maxSize, m_stageSize - m_stageReaded);
+            if (m_frameSize + writeSize > m_maxFrameSize)
+                return nullptr;
+
+            switch (m_stage)
+            {
+            case Stage::VtxData:
+                return GrowBuffer(m_cmdLists[m_decodedCmdListsCount].vtxBuffer, writeSize);
+            case Stage::IdxData:
+                return GrowBuffer(m_cmdLists[m_decodedCmdListsCount].idxBuffer, writeSize);
+            case Stage::CmdData:
+                return GrowBuffer(m_cmdLists[m_decodedCmdListsCount].cmdBuffer, writeSize);
+            default:
+                return m_header + m_stageReaded;
+            }
+        }
+
+        bool EndWrite(size_t writtenSize)
+        {
+            if (Stage::Completed == m_stage || writtenSize > m_stageSize - m_stageReaded)
+                return false;
+
+            m_frameSize += writtenSize;
+            m_stageReaded += writtenSize;
+            while (Stage::Completed != m_stage && m_stageReaded == m_stageSize)
+            {
+                if (!NextStage())
+                    return false;
+            }
+
+            return true;
+        }
+
+        // Prepare for the next frame, storage that grew for a spike is released here
+        void Reset()
+        {
+            if (m_cmdLists.size() > static_cast<size_t>(m_cmdListsCount))
+                m_cmdLists.resize(m_cmdListsCount);
+            for (auto &cmdList : m_cmdLists)
+            {
+                ShrinkAfterSpike(cmdList.vtxBuffer);
+                ShrinkAfterSpike(cmdList.idxBuffer);
+                ShrinkAfterSpike(cmdList.cmdBuffer);
+            }
+
+            m_frameSize = 0;
+            m_cmdListsCount = 0;
+            m_decodedCmdListsCount = 0;
+            BeginStage(Stage::Header, sizeof(m_header));
+        }
+
+        bool IsCompleted() const
+        {
+            return Stage::Completed == m_stage;
+        }
+
+        int GetCmdListsCount() const
+        {
+            return m_cmdListsCount;
+        }
+
+        const ImVec2 &GetDisplayPos() const
+        {
+            return m_displayPos;
+        }
+
+        const ImVec2 &GetFramebufferScale() const
+        {
+            return m_framebufferScale;
+        }
+
+        const CmdListData &GetCmdList(int index) const
+        {
+            return m_cmdLists[index];
+        }
+
+    private:
+        enum class Stage
+        {
+            Header,
+            VtxCount,
+            VtxData,
+            IdxCount,
+            IdxData,
+            CmdCount,
+            CmdData,
+            Completed,
+        };
+
+        template <typename T>
+        static void ShrinkAfterSpike(ImVector<T> &buffer)
+        {
+            // NOTE: The content is not needed anymore, so the storage is simply released
+            if (buffer.Capacity * sizeof(T) > 64 * 1024 && buffer.Capacity > buffer.Size * 4)
+                buffer.clear();
+        }
+
+        template <typename T>
+        uint8_t *GrowBuffer(ImVector<T> &buffer, size_t writeSize)
+        {
+            auto count = static_cast<int>((m_stageReaded + writeSize + sizeof(T) - 1) / sizeof(T));
+            if (buffer.Size < count)
+                buffer.resize(count);
+
+            return reinterpret_cast<uint8_t *>(buffer.Data) + m_stageReaded;
+        }
+
+        template <typename T>
+        bool BeginBufferStage(Stage stage, ImVector<T> &buffer)
+        {
+            int count = 0;
+            memcpy(&count, m_header, sizeof(count));
+            if (0 > count || static_cast<size_t>(count) * sizeof(T) > m_maxFrameSize - m_frameSize)
+                return false;
+
+            buffer.resize(0);
+            BeginStage(stage, count * sizeof(T));
+
+            return true;
+        }
+
+        bool BeginCmdList()
+        {
+            if (m_cmdLists.size() <= static_cast<size_t>(m_decodedCmdListsCount))
+                m_cmdLists.emplace_back();
+
+            BeginStage(Stage::VtxCount, sizeof(int));
+            return true;
+        }
 
+        void BeginStage(Stage stage, size_t size)
+        {
+            m_stage = stage;
+            m_stageSize = size;
+            m_stageReaded = 0;
+        }
+
+        bool NextStage()
+        {
+            switch (m_stage)
+            {
+            case Stage::Header:
+            {
+                size_t readIndex = 0;
+
+                // Read cmd lists count
+                memcpy(&m_cmdListsCount, m_header + readIndex, sizeof(m_cmdListsCount));
+                readIndex += sizeof(m_cmdListsCount);
+                // Read display pos
+                memcpy(&m_displayPos, m_header + readIndex, sizeof(m_displayPos));
+                readIndex += sizeof(m_displayPos);
+                // Read frame buffer scale
+                memcpy(&m_framebufferScale, m_header + readIndex, sizeof(m_framebufferScale));
+                readIndex += sizeof(m_framebufferScale);
+
+                // NOTE: Every cmd list becomes an ImGui window that lives as long as the process
+                if (0 > m_cmdListsCount || m_cmdListsCount > m_maxCmdListsCount)
+                    return false;
+                if (0 == m_cmdListsCount)
+                {
+                    BeginStage(Stage::Completed, 0);
+                    break;
+                }
+
+                m_cmdLists.reserve(m_cmdListsCount);
+                return BeginCmdList();
+            }
+            case Stage::VtxCount:
+                return BeginBufferStage(Stage::VtxData, m_cmdLists[m_decodedCmdListsCount].vtxBuffer);
+            case Stage::VtxData:
+                BeginStage(Stage::IdxCount, sizeof(int));
+                break;
+            case Stage::IdxCount:
+                return BeginBufferStage(Stage::IdxData, m_cmdLists[m_decodedCmdListsCount].idxBuffer);
+            case Stage::IdxData:
+                BeginStage(Stage::CmdCount, sizeof(int));
+                break;
+            case Stage::CmdCount:
+                return BeginBufferStage(Stage::CmdData, m_cmdLists[m_decodedCmdListsCount].cmdBuffer);
+            case Stage::CmdData:
+            {
+                // NOTE: Callbacks are pointers of the other process
+                for (auto &cmd : m_cmdLists[m_decodedCmdListsCount].cmdBuffer)
+                {
+                    cmd.UserCallback = nullptr;
+                    cmd.UserCallbackData = nullptr;
+                }
+
+                if (++m_decodedCmdListsCount < m_cmdListsCount)
+                    return BeginCmdList();
+                BeginStage(Stage::Completed, 0);
+                break;
+            }
+            default:
+                return false;
+            }
+
+            return true;
+        }
+
+    private:
+        size_t m_maxFrameSize = 0, m_frameSize = 0;
+        int m_maxCmdListsCount = 0;
+
+        Stage m_stage = Stage::Header;
+        size_t m_stageSize = sizeof(m_header), m_stageReaded = 0;
+        uint8_t m_header[sizeof(int) + sizeof(ImVec2) * 2]{};
+
+        int m_cmdListsCount = 0, m_decodedCmdListsCount = 0;
+        ImVec2 m_displayPos, m_framebufferScale;
+        std::vector<CmdListData> m_cmdLists;
+    };
+
+    ImDrawData *PrepareSharedDrawData(int cmdListsCount)
+    {
         // Prepare draw data
         static bool showWindow = true;
         auto drawData = ImGui::GetDrawData();
@@ -179,6 +437,24 @@ namespace ImGui
             drawData = ImGui::GetDrawData();
         } while (0 == drawData->CmdListsCount);
 
+        return drawData;
+    }
+
+    ImDrawData *RenderSharedDrawData(const std::vector<uint8_t> &data)
+    {
+        size_t readIndex = 0;
+
+        if (data.empty())
+            return ImGui::GetDrawData();
+
+        // Read cmd lists count
+        int cmdListsCount = *reinterpret_cast<int *>(const_cast<uint8_t *>(data.data()));
+        readIndex += sizeof(cmdListsCount);
+        if (1 > cmdListsCount)
+            return ImGui::GetDrawData();
+
+        auto drawData = PrepareSharedDrawData(cmdListsCount);
+
         // Read display pos
         memcpy(&drawData->DisplayPos, data.data() + readIndex, sizeof(drawData->DisplayPos));
         readIndex += sizeof(drawData->DisplayPos);
@@ -212,6 +488,41 @@ namespace ImGui
 
         return drawData;
     }
+
+    ImDrawData *RenderSharedDrawData(const SharedDrawDataDecoder &decoder)
+    {
+        // NOTE: The current draw data may still slice the other decoder, never hand it out
+        if (!decoder.IsCompleted() || 1 > decoder.GetCmdListsCount())
+            return nullptr;
+
+        auto drawData = PrepareSharedDrawData(decoder.GetCmdListsCount());
+
+        drawData->DisplayPos = decoder.GetDisplayPos();
+        drawData->FramebufferScale = decoder.GetFramebufferScale();
+
+        for (int i = 0; i < (std::min)(drawData->CmdListsCount, decoder.GetCmdListsCount()); ++i)
+        {
+            auto &cmdList = drawData->CmdLists[i];
+            auto &sharedCmdList = decoder.GetCmdList(i);
+
+            // Slice vertex buffer
+            cmdList->VtxBuffer.clear();
+            cmdList->VtxBuffer.Size = sharedCmdList.vtxBuffer.Size;
+            cmdList->VtxBuffer.Data = sharedCmdList.vtxBuffer.Data;
+
+            // Slice index buffer
+            cmdList->IdxBuffer.clear();
+            cmdList->IdxBuffer.Size = sharedCmdList.idxBuffer.Size;
+            cmdList->IdxBuffer.Data = sharedCmdList.idxBuffer.Data;
+
+            // Slice cmd buffer
+            cmdList->CmdBuffer.clear();
+            cmdList->CmdBuffer.Size = sharedCmdList.cmdBuffer.Size;
+            cmdList->CmdBuffer.Data = sharedCmdList.cmdBuffer.Data;
+        }
+
+        return drawData;
+    }
 }
 
 #endif //! IMGUI_SHARED_DRAWDATA_H
\ No newline at end of file
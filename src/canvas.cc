@@ -7,7 +7,6 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
-#include <iomanip>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -20,12 +19,16 @@ enum class RenderState
     ReadData,
 };
 
+size_t g_maxFontDataSize = 16 * 1024 * 1024 + 2 * sizeof(int); // 4096x4096 alpha8 atlas with its width and height
+size_t g_maxFrameSize = 64 * 1024 * 1024;                        // 64MB
+int g_maxCmdListsCount = 4096;
+
 std::atomic<RenderState> g_renderState = RenderState::ReadData;
-std::vector<uint8_t> g_sharedFontData;
-std::vector<uint8_t> g_sharedDrawData, g_sharedDrawDataBack;
+std::vector<uint8_t> g_sharedFontData, g_sharedFontDataBack;
+ImGui::SharedDrawDataDecoder g_sharedDrawDecoders[2]{{g_maxFrameSize, g_maxCmdListsCount}, {g_maxFrameSize, g_maxCmdListsCount}};
+ImGui::SharedDrawDataDecoder *g_sharedDrawDecoder = &g_sharedDrawDecoders[0], *g_sharedDrawDecoderBack = &g_sharedDrawDecoders[1];
 
 bool g_work = true;
-size_t g_maxPacketSize = 1 * 1024 * 1024; // 1MB
 SOCKET g_dataFd = INVALID_SOCKET;
 
 int ReadData(void *buffer, size_t readSize)
@@ -42,6 +45,37 @@ int ReadData(void *buffer, size_t readSize)
 
     return static_cast<int>(packetReaded);
 }
+bool ReadDrawData(size_t readSize)
+{
+    size_t writeSize = 0;
+
+    // NOTE: Receive straight into the decoder storage
+    while (0 < readSize)
+    {
+        auto buffer = g_sharedDrawDecoderBack->BeginWrite(readSize, writeSize);
+        if (nullptr == buffer)
+        {
+            std::cout << "[-] Draw data is malformed or too large" << std::endl;
+            return false;
+        }
+
+        auto readResult = ReadData(buffer, writeSize);
+        if (0 >= readResult)
+        {
+            std::cout << "[-] Client disconnect or read failed, readResult:" << readResult << std::endl;
+            return false;
+        }
+
+        if (!g_sharedDrawDecoderBack->EndWrite(writeSize))
+        {
+            std::cout << "[-] Draw data is malformed or too large" << std::endl;
+            return false;
+        }
+        readSize -= writeSize;
+    }
+
+    return true;
+}
 void WriteData(void *data, size_t size)
 {
     ::send(g_dataFd, reinterpret_cast<char *>(data), static_cast<int>(size), 0);
@@ -90,41 +124,69 @@ void RenderService()
             exit(0);
         }
 
-        uint32_t packetSize = 0, packetReaded = 0;
+        // NOTE: Packets are sent as chunks, a zero size chunk ends the packet
+        uint32_t chunkSize = 0;
+        g_sharedFontDataBack.clear();
+        g_sharedDrawDecoderBack->Reset();
         while (g_work)
         {
-            if (static_cast<int>(sizeof(packetSize)) > ReadData(&packetSize, sizeof(packetSize)))
+            if (static_cast<int>(sizeof(chunkSize)) > ReadData(&chunkSize, sizeof(chunkSize)))
             {
-                std::cout << "[-] Can not read packet size: " << ::WSAGetLastError() << std::endl;
+                std::cout << "[-] Can not read chunk size: " << ::WSAGetLastError() << std::endl;
                 break;
             }
-            if (packetSize > g_maxPacketSize)
+            if (chunkSize > ImGui::SharedDataMaxChunkSize)
             {
-                std::cout << "[-] Packet is too large: " << std::setprecision(2) << std::fixed << (packetSize / 1024.f / 1024.f) << std::endl;
+                std::cout << "[-] Chunk is too large: " << chunkSize << std::endl;
                 break;
             }
 
-            if (g_sharedDrawDataBack.size() < packetSize)
-                g_sharedDrawDataBack.resize(packetSize);
-            auto readResult = ReadData(g_sharedDrawDataBack.data(), packetSize);
-            if (0 >= readResult)
+            if (0 < chunkSize)
             {
-                std::cout << "[-] Client disconnect or read failed, readResult:" << readResult << std::endl;
-                break;
-            }
+                if (g_sharedFontData.empty()) // NOTE: First packet is font data
+                {
+                    auto readIndex = g_sharedFontDataBack.size();
+                    if (readIndex + chunkSize > g_maxFontDataSize)
+                    {
+                        std::cout << "[-] Font data is too large" << std::endl;
+                        break;
+                    }
+
+                    g_sharedFontDataBack.resize(readIndex + chunkSize);
+                    auto readResult = ReadData(g_sharedFontDataBack.data() + readIndex, chunkSize);
+                    if (0 >= readResult)
+                    {
+                        std::cout << "[-] Client disconnect or read failed, readResult:" << readResult << std::endl;
+                        break;
+                    }
+                }
+                else if (!ReadDrawData(chunkSize))
+                    break;
 
-            if (RenderState::ReadData != g_renderState)
                 continue;
-            if (g_sharedFontData.empty()) // NOTE: First packet is font data
+            }
+
+            if (!g_sharedFontData.empty() && !g_sharedDrawDecoderBack->IsCompleted())
             {
-                g_sharedFontData.swap(g_sharedDrawDataBack);
-                g_renderState = RenderState::SetFont;
+                std::cout << "[-] Draw data is incomplete" << std::endl;
+                break;
             }
-            else
+
+            if (RenderState::ReadData == g_renderState)
             {
-                g_sharedDrawData.swap(g_sharedDrawDataBack);
-                g_renderState = RenderState::Rendering;
+                if (g_sharedFontData.empty())
+                {
+                    g_sharedFontData.swap(g_sharedFontDataBack);
+                    g_renderState = RenderState::SetFont;
+                }
+                else
+                {
+                    std::swap(g_sharedDrawDecoder, g_sharedDrawDecoderBack);
+                    g_renderState = RenderState::Rendering;
+                }
             }
+            g_sharedFontDataBack.clear();
+            g_sharedDrawDecoderBack->Reset();
         }
     }
 
@@ -220,7 +282,7 @@ int main()
         }
         case RenderState::Rendering:
         {
-            auto sharedData = ImGui::RenderSharedDrawData(g_sharedDrawData);
+            auto sharedData = ImGui::RenderSharedDrawData(*g_sharedDrawDecoder);
             if (nullptr != sharedData)
             {
                 glClear(GL_COLOR_BUFFER_BIT);
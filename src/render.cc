@@ -41,12 +41,12 @@ void ConnectToRenderService()
 
 void SendToRender(const std::vector<uint8_t> &sharedData)
 {
-    if (sharedData.empty())
-        return;
-
-    uint32_t packetSize = static_cast<uint32_t>(sharedData.size());
-    send(g_dataFd, reinterpret_cast<char *>(&packetSize), sizeof(packetSize), 0);
-    send(g_dataFd, reinterpret_cast<const char *>(sharedData.data()), static_cast<int>(sharedData.size()), 0);
+    ImGui::WriteSharedDataChunks(
+        sharedData,
+        [](const void *data, size_t size)
+        {
+            send(g_dataFd, reinterpret_cast<const char *>(data), static_cast<int>(size), 0);
+        });
 }
 
 int main()